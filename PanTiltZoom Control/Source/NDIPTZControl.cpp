@@ -61,6 +61,9 @@
 #include <stdio.h>
 #include <iostream>
 #include <vector>
+#include <atomic>
+#include <new>
+#include <thread>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -116,6 +119,13 @@
 
 #endif
 
+// ---------------------------------------------------------------------------------
+// Linux Specific (headless test host - see Test/README.md)
+// ---------------------------------------------------------------------------------
+#if TARGET_OS_LINUX
+#define EXPORT_ __attribute__((visibility("default")))
+#endif
+
 // ---------------------------------------------------------------------------------
 //	Exported Function Definitions
 // ---------------------------------------------------------------------------------
@@ -142,7 +152,47 @@ EXPORT_ void GetActorInfo(void* inParam, ActorInfo* outActorParams);
 
 // Example: static int gMyGlobalVariable = 5;
 
+// The NDI library is shared by all live actors. It is initialized by the first actor
+// that needs it (and retried by later ones if that failed), and destroyed when the
+// last actor is disposed - but only if it was actually initialized. See RetainNDILib
+// / NDILibReady / ReleaseNDILib.
+//
+// These are plain statics, not atomics or a mutex: Isadora calls CreateActor,
+// DisposeActor and HandlePropertyChangeValue on its own thread, one at a time, and
+// worker threads never touch them. This keeps the property callback lock free.
+static int			gNDILibActorCount = 0;
+static bool			gNDILibInitialized = false;
+
+
+// ---------------------------------------------------------------------------------
+// PTZState struct
+// ---------------------------------------------------------------------------------
+// Pan, tilt and zoom amounts shared between the Isadora callback (the only writer)
+// and anything that sends moves to the camera. The three values are guarded by a
+// sequence counter so a reader always sees a consistent triple without taking a
+// lock: the counter is odd while a write is in progress, and a reader retries
+// whenever it sees an odd value or the counter changed under it.
+
+typedef struct {
+
+	float					mHorizAmount;
+	float					mVertAmount;
+	float					mZoomAmount;
+
+} PTZAmounts;
+
+typedef struct {
+
+	std::atomic<uint32_t>	mSequence;
+	std::atomic<float>		mHorizAmount;
+	std::atomic<float>		mVertAmount;
+	std::atomic<float>		mZoomAmount;
+
+} PTZState;
 
+// Number of threads that may hold the NDI receiver at the same time. Each one
+// publishes the handle it is using in one of these slots; see AcquireReceiver.
+enum { kReceiverHazardSlots = 8 };
 
 // ---------------------------------------------------------------------------------
 // PluginInfo struct
@@ -151,6 +201,10 @@ EXPORT_ void GetActorInfo(void* inParam, ActorInfo* outActorParams);
 // this struct is allocated during the CreateActor function, and disposed during
 // the DisposeActor function, and is private to each copy of the plugin.
 //
+// Because it holds C++ members (std::string, std::atomic), the struct is constructed
+// in place with placement new after allocation and explicitly destroyed before the
+// memory is freed.
+//
 // If your plugin needs global data, declare them as static variables within this
 // file. Any static variable will be global to all instantiations of the plugin.
 
@@ -164,11 +218,16 @@ typedef struct {
 	//std::vector<std::string> ndiList;
 	std::string				mSelectedNDIName;
 
-	float					mHorizAmount;
-	float					mVertAmount;
-	float					mZoomAmount;
+	PTZState				mPTZ;					// pan / tilt / zoom amounts - see ReadPTZState / WritePTZState
 
-	NDIlib_recv_instance_t pNDI_recv;
+	// The current NDI receiver. Never use it through a plain load: take it with
+	// AcquireReceiver and hand it back with ReleaseReceiver, and change it only through
+	// ReplaceReceiver. A replaced receiver is moved to mRetiredRecvs and destroyed by a
+	// later ReplaceReceiver once no thread holds it, so the callback never waits on a
+	// worker. Only DisposeActor waits, for at most one capture timeout per holder.
+	std::atomic<NDIlib_recv_instance_t> pNDI_recv;
+	std::atomic<NDIlib_recv_instance_t> mRecvHazards[kReceiverHazardSlots];
+	std::vector<NDIlib_recv_instance_t> mRetiredRecvs;	// callback thread only
 
 	
 } PluginInfo;
@@ -181,6 +240,210 @@ typedef struct {
 #define	GetPluginInfo_(actorDataPtr)		(PluginInfo*)((actorDataPtr)->mActorDataPtr);
 #endif
 
+// ---------------------------------------------------------------------------------
+//		 WritePTZState
+// ---------------------------------------------------------------------------------
+//	Publishes a new pan / tilt / zoom triple. Only the Isadora callback thread may
+//	call this function.
+
+static void
+WritePTZState(
+	PTZState*			ioState,
+	const PTZAmounts&	inAmounts)
+{
+	uint32_t seq = ioState->mSequence.load(std::memory_order_relaxed);
+	
+	// mark the write as in progress - the release stores below keep this store
+	// ahead of them, so a reader that sees any new amount also sees the odd count
+	ioState->mSequence.store(seq + 1, std::memory_order_relaxed);
+	
+	ioState->mHorizAmount.store(inAmounts.mHorizAmount, std::memory_order_release);
+	ioState->mVertAmount.store(inAmounts.mVertAmount, std::memory_order_release);
+	ioState->mZoomAmount.store(inAmounts.mZoomAmount, std::memory_order_release);
+	
+	// mark the write as complete
+	ioState->mSequence.store(seq + 2, std::memory_order_release);
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReadPTZState
+// ---------------------------------------------------------------------------------
+//	Returns a consistent snapshot of the pan / tilt / zoom triple. Safe to call from
+//	any thread; never blocks the writer.
+
+static PTZAmounts
+ReadPTZState(
+	const PTZState*		inState)
+{
+	PTZAmounts amounts;
+	uint32_t seqBefore;
+	uint32_t seqAfter;
+	
+	do {
+		seqBefore = inState->mSequence.load(std::memory_order_acquire);
+		
+		amounts.mHorizAmount = inState->mHorizAmount.load(std::memory_order_acquire);
+		amounts.mVertAmount = inState->mVertAmount.load(std::memory_order_acquire);
+		amounts.mZoomAmount = inState->mZoomAmount.load(std::memory_order_acquire);
+		
+		seqAfter = inState->mSequence.load(std::memory_order_relaxed);
+		
+	} while ((seqBefore & 1) != 0 || seqBefore != seqAfter);
+	
+	return amounts;
+}
+
+// ---------------------------------------------------------------------------------
+//		 AcquireReceiver
+// ---------------------------------------------------------------------------------
+//	Returns the current NDI receiver (or NULL if there is none) and marks it as in
+//	use, so that ReplaceReceiver will not destroy it until ReleaseReceiver is called
+//	with the slot returned in outSlot. Safe to call from any thread.
+
+static NDIlib_recv_instance_t
+AcquireReceiver(
+	PluginInfo*			info,
+	int*				outSlot)
+{
+	for (;;) {
+	
+		NDIlib_recv_instance_t recv = info->pNDI_recv.load();
+		if (recv == NULL) {
+			return NULL;
+		}
+		
+		// claim a free hazard slot for this receiver
+		int slot = -1;
+		for (int i = 0; i < kReceiverHazardSlots && slot < 0; i++) {
+			NDIlib_recv_instance_t expected = NULL;
+			if (info->mRecvHazards[i].compare_exchange_strong(expected, recv)) {
+				slot = i;
+			}
+		}
+		
+		if (slot < 0) {
+			std::this_thread::yield();
+			continue;
+		}
+		
+		// if the receiver was swapped before we published it, it may already be
+		// on its way to being destroyed - let go of it and try again
+		if (info->pNDI_recv.load() == recv) {
+			*outSlot = slot;
+			return recv;
+		}
+		
+		info->mRecvHazards[slot].store(NULL);
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReleaseReceiver
+// ---------------------------------------------------------------------------------
+//	Hands back a receiver obtained from AcquireReceiver.
+
+static void
+ReleaseReceiver(
+	PluginInfo*			info,
+	int					inSlot)
+{
+	info->mRecvHazards[inSlot].store(NULL);
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReclaimRetiredReceivers
+// ---------------------------------------------------------------------------------
+//	Destroys every retired receiver that no thread holds anymore, and returns true
+//	if none are left. Only the Isadora callback thread may call this function.
+
+static bool
+ReclaimRetiredReceivers(
+	PluginInfo*			info)
+{
+	size_t kept = 0;
+	
+	for (size_t r = 0; r < info->mRetiredRecvs.size(); r++) {
+		NDIlib_recv_instance_t recv = info->mRetiredRecvs[r];
+		
+		bool inUse = false;
+		for (int i = 0; i < kReceiverHazardSlots && !inUse; i++) {
+			inUse = info->mRecvHazards[i].load() == recv;
+		}
+		
+		if (inUse) {
+			info->mRetiredRecvs[kept++] = recv;
+		} else {
+			NDIlib_recv_destroy(recv);
+		}
+	}
+	
+	info->mRetiredRecvs.resize(kept);
+	return kept == 0;
+}
+
+// ---------------------------------------------------------------------------------
+//		 ReplaceReceiver
+// ---------------------------------------------------------------------------------
+//	Installs inNewRecv (which may be NULL) as the current receiver and retires the
+//	one it replaces. Never waits: a retired receiver still in use by another thread
+//	is destroyed by a later call, or by DisposeActor. Only the Isadora callback
+//	thread may call this function.
+
+static void
+ReplaceReceiver(
+	PluginInfo*				info,
+	NDIlib_recv_instance_t	inNewRecv)
+{
+	NDIlib_recv_instance_t oldRecv = info->pNDI_recv.exchange(inNewRecv);
+	if (oldRecv != NULL) {
+		info->mRetiredRecvs.push_back(oldRecv);
+	}
+	
+	ReclaimRetiredReceivers(info);
+}
+
+// ---------------------------------------------------------------------------------
+//		 NDILibReady
+// ---------------------------------------------------------------------------------
+//	Returns true once the NDI library is initialized, trying again if an earlier
+//	attempt failed. Only the Isadora callback thread may call this function.
+
+static bool
+NDILibReady()
+{
+	if (!gNDILibInitialized) {
+		gNDILibInitialized = NDIlib_initialize();
+		if (!gNDILibInitialized) {
+			std::cout << "failed to init ndi" << std::endl;
+		}
+	}
+	
+	return gNDILibInitialized;
+}
+
+// ---------------------------------------------------------------------------------
+//		 RetainNDILib / ReleaseNDILib
+// ---------------------------------------------------------------------------------
+//	Called once per actor from CreateActor and DisposeActor. The last release
+//	destroys the library, if it was ever initialized.
+
+static void
+RetainNDILib()
+{
+	gNDILibActorCount++;
+	NDILibReady();
+}
+
+static void
+ReleaseNDILib()
+{
+	gNDILibActorCount--;
+	if (gNDILibActorCount == 0 && gNDILibInitialized) {
+		NDIlib_destroy();
+		gNDILibInitialized = false;
+	}
+}
+
 // ---------------------------------------------------------------------------------
 //	Constants
 // ---------------------------------------------------------------------------------
@@ -303,8 +566,11 @@ CreateActor(
 	ActorInfo*			ioActorInfo)		// pointer to this actor's ActorInfo struct - unique to each instance of an actor
 {
 	// creat the PluginInfo struct - initializing it to all zeroes
-	PluginInfo* info = (PluginInfo*) IzzyMallocClear_(ip, sizeof(PluginInfo));
-	PluginAssert_(ip, info != nil);
+	void* infoMem = IzzyMallocClear_(ip, sizeof(PluginInfo));
+	PluginAssert_(ip, infoMem != nil);
+	
+	// construct its members in place (value-initialized, so the atomics start at zero)
+	PluginInfo* info = new (infoMem) PluginInfo();
 	
 	ioActorInfo->mActorDataPtr = info;
 	info->mActorInfoPtr = ioActorInfo;
@@ -312,9 +578,7 @@ CreateActor(
 	info->mNDIIndex = 0;
 
 	// ### allocation and initialization of private member variables
-	if (!NDIlib_initialize()) {
-		std::cout << "failed to init ndi" << std::endl;
-	}
+	RetainNDILib();
 	
 	
 }
@@ -334,14 +598,19 @@ DisposeActor(
 	PluginAssert_(ip, info != nil);
 	
 	// ### destruction of private member variables
-	// Destroy the receiver
-	NDIlib_recv_destroy(info->pNDI_recv);
+	// Destroy the receiver - any thread still capturing from it lets go within
+	// its capture timeout
+	ReplaceReceiver(info, NULL);
+	while (!ReclaimRetiredReceivers(info)) {
+		std::this_thread::yield();
+	}
 
-	// Not required, but nice
-	NDIlib_destroy();
+	// Not required, but nice - only once the last actor is gone
+	ReleaseNDILib();
 
 	// destroy the PluginInfo struct allocated with IzzyMallocClear_ the CreateActor function
 	PluginAssert_(ip, ioActorInfo->mActorDataPtr != nil);
+	info->~PluginInfo();
 	IzzyFree_(ip, ioActorInfo->mActorDataPtr);
 }
 
@@ -457,8 +726,15 @@ HandlePropertyChangeValue(
 		// NDI Index Changed
 		case kNDIIndex:
 		{
-			//get the index supplied to the actor and update the stored NDI index
-			info->mNDIIndex = (int)inNewValue->u.ivalue;
+			//get the index supplied to the actor - the stored index, name and output
+			//are only updated once a receiver for it is in place, so that they always
+			//describe the camera we are actually driving
+			int newNDIIndex = (int)inNewValue->u.ivalue;
+
+			//make sure NDI is up before looking for sources
+			if (!NDILibReady()) {
+				break;
+			}
 
 			//now update the vector of all NDI feeds
 			NDIlib_find_create_t NDI_find_create_desc; /* Use defaults */
@@ -480,74 +756,94 @@ HandlePropertyChangeValue(
 
 
 			if (p_sources == NULL) {
+				NDIlib_find_destroy(pNDI_find);
 				break;
 			}
 
-			//if we found sources, save the name of the feed at the selection index
+			//if we found sources, keep the name of the feed at the selection index
 			//log_info("*NDI* %p Found %d Sources\n", this, (int)no_sources);
-			if (info->mNDIIndex < no_sources) {
-				info->mSelectedNDIName = std::string(p_sources[info->mNDIIndex].p_ndi_name);
-			}
-			else {
+			if (newNDIIndex < 0 || (uint32_t)newNDIIndex >= no_sources) {
+				NDIlib_find_destroy(pNDI_find);
 				break;
 			}
 
-			//set the outtext on the actor to display the name of the NDI feed at the input index
-			Value kOutTextValue = { kString, nil };
-			AllocateValueString_(ip, info->mSelectedNDIName.c_str(), &kOutTextValue);
-			SetOutputPropertyValue_(ip, info->mActorInfoPtr, kOutText, &kOutTextValue);
+			//copy the name now - it belongs to the finder
+			std::string newNDIName(p_sources[newNDIIndex].p_ndi_name);
 
 			//Now create the receiver handler
 			NDIlib_recv_create_v3_t NDI_recv_create_desc;
-			NDI_recv_create_desc.source_to_connect_to = p_sources[info->mNDIIndex];
+			NDI_recv_create_desc.source_to_connect_to = p_sources[newNDIIndex];
 			NDI_recv_create_desc.p_ndi_recv_name = "Isadora PTZ Receiver";
 
-			//save it
-			info->pNDI_recv = NDIlib_recv_create_v3(&NDI_recv_create_desc);
-			if (!info->pNDI_recv) {
+			NDIlib_recv_instance_t newRecv = NDIlib_recv_create_v3(&NDI_recv_create_desc);
+
+			//destroy the finder - the receiver keeps its own copy of the source
+			NDIlib_find_destroy(pNDI_find);
+
+			if (!newRecv) {
 				break;
 			}
 
-			//destroy the finder
-			NDIlib_find_destroy(pNDI_find);
+			//save it, and destroy the receiver it replaces
+			ReplaceReceiver(info, newRecv);
+
+			info->mNDIIndex = newNDIIndex;
+			info->mSelectedNDIName = newNDIName;
+
+			//set the outtext on the actor to display the name of the NDI feed at the input index
+			Value kOutTextValue = { kString, nil };
+			AllocateValueString_(ip, info->mSelectedNDIName.c_str(), &kOutTextValue);
+			SetOutputPropertyValue_(ip, info->mActorInfoPtr, kOutText, &kOutTextValue);
 
 			break;
 
 		}
 		case kVertAmnt: // Vertical movement amount changed
 		{
-			info->mVertAmount = (float)inNewValue->u.fvalue;
+			PTZAmounts amounts = ReadPTZState(&info->mPTZ);
+			amounts.mVertAmount = (float)inNewValue->u.fvalue;
+			WritePTZState(&info->mPTZ, amounts);
 			break;
 		}
 		case kHorizAmnt: // Horizontal movement amount changed
 		{
-			info->mHorizAmount = (float)inNewValue->u.fvalue;
+			PTZAmounts amounts = ReadPTZState(&info->mPTZ);
+			amounts.mHorizAmount = (float)inNewValue->u.fvalue;
+			WritePTZState(&info->mPTZ, amounts);
 			break;
 		}
 		case kZoomAmnt: // Zoom movement amount changed
 		{
-			info->mZoomAmount = (float)inNewValue->u.fvalue;
+			PTZAmounts amounts = ReadPTZState(&info->mPTZ);
+			amounts.mZoomAmount = (float)inNewValue->u.fvalue;
+			WritePTZState(&info->mPTZ, amounts);
 			break;
 		}
 	
 		// reset output is triggered
 		case kTriggerGo:
 		{
+			int recvSlot;
+			NDIlib_recv_instance_t recv = AcquireReceiver(info, &recvSlot);
+			if (recv == NULL) {
+				break;
+			}
 
 			// Receive something
-			switch (NDIlib_recv_capture_v3(info->pNDI_recv, NULL, NULL, NULL, 1000))
+			switch (NDIlib_recv_capture_v3(recv, NULL, NULL, NULL, 1000))
 			{	// There is a status change on the receiver (e.g. new web interface)
 				case NDIlib_frame_type_status_change:
 				{	// Get the Web UR
-					if (NDIlib_recv_ptz_is_supported(info->pNDI_recv))
+					if (NDIlib_recv_ptz_is_supported(recv))
 					{	// Display the details
 						//printf("This source supports PTZ functionality. Moving to preset #3.\n");
 
 						// Move it to preset number  as quickly as it can go !
 						//NDIlib_recv_ptz_recall_preset(pNDI_recv, 3, 1.0);
 
-						NDIlib_recv_ptz_pan_tilt(info->pNDI_recv, info->mHorizAmount, info->mVertAmount);
-						NDIlib_recv_ptz_zoom(info->pNDI_recv, info->mZoomAmount);
+						PTZAmounts amounts = ReadPTZState(&info->mPTZ);
+						NDIlib_recv_ptz_pan_tilt(recv, amounts.mHorizAmount, amounts.mVertAmount);
+						NDIlib_recv_ptz_zoom(recv, amounts.mZoomAmount);
 					}
 
 				}	
@@ -558,6 +854,7 @@ HandlePropertyChangeValue(
 					break;
 			}
 
+			ReleaseReceiver(info, recvSlot);
 			break;
 		}
 	}
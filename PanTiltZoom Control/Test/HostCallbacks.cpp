@@ -0,0 +1,161 @@
+// ===========================================================================
+//	HostCallbacks.cpp - Isadora callbacks provided by the headless host
+// ===========================================================================
+
+#include "HostCallbacks.h"
+
+#include <IsadoraCallbacks.h>
+#include <PluginDrawUtil.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+#include <mutex>
+
+// Every block handed out by IzzyMallocClear_ is preceded by its size so that
+// IzzyFree_ can keep the live byte count.
+typedef struct {
+	size_t		mSize;
+	double		mAlign;
+} AllocHeader;
+
+static std::mutex						gMutex;
+static HostCounters						gCounters;
+static std::map<PropertyIndex, std::string>	gOutputs;
+static std::string						gLastAllocatedString;
+
+void
+HostCallbacks_Reset()
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	
+	gCounters = HostCounters();
+	gOutputs.clear();
+}
+
+HostCounters
+HostCallbacks_GetCounters()
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	return gCounters;
+}
+
+std::string
+HostCallbacks_GetOutputString(
+	PropertyIndex	inPropertyIndex1)
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	
+	std::map<PropertyIndex, std::string>::const_iterator it = gOutputs.find(inPropertyIndex1);
+	return it == gOutputs.end() ? std::string() : it->second;
+}
+
+// ---------------------------------------------------------------------------------
+// Callbacks
+// ---------------------------------------------------------------------------------
+
+void*
+IzzyMallocClear_(
+	IsadoraParameters*	/* ip */,
+	size_t				inSize)
+{
+	AllocHeader* header = (AllocHeader*) calloc(1, sizeof(AllocHeader) + inSize);
+	if (header == NULL) {
+		return NULL;
+	}
+	header->mSize = inSize;
+	
+	std::lock_guard<std::mutex> lock(gMutex);
+	gCounters.mAllocations++;
+	gCounters.mLiveBytes += (long) inSize;
+	
+	return header + 1;
+}
+
+void
+IzzyFree_(
+	IsadoraParameters*	/* ip */,
+	void*				inPtr)
+{
+	if (inPtr == NULL) {
+		return;
+	}
+	
+	AllocHeader* header = static_cast<AllocHeader*>(inPtr) - 1;
+	
+	{
+		std::lock_guard<std::mutex> lock(gMutex);
+		gCounters.mFrees++;
+		gCounters.mLiveBytes -= (long) header->mSize;
+	}
+	
+	free(header);
+}
+
+void
+HostPluginAssert(
+	bool			inCondition,
+	const char*		inExpression,
+	const char*		inFile,
+	int				inLine)
+{
+	if (inCondition) {
+		return;
+	}
+	
+	fprintf(stderr, "PluginAssert_ failed: %s (%s:%d)\n", inExpression, inFile, inLine);
+	
+	std::lock_guard<std::mutex> lock(gMutex);
+	gCounters.mAssertFailures++;
+}
+
+UInt32
+PropertyTypeAndIndexToHelpIndex_(
+	IsadoraParameters*	/* ip */,
+	ActorInfo*			/* inActorInfo */,
+	PropertyType		/* inPropertyType */,
+	PropertyIndex		/* inPropertyIndex1 */)
+{
+	// help strings are never requested by the headless host
+	return 0;
+}
+
+// The real callback allocates storage owned by Isadora. The host keeps only the
+// most recent string, which is enough for the plugin's allocate-then-set usage.
+void
+AllocateValueString_(
+	IsadoraParameters*	/* ip */,
+	const char*			inString,
+	Value*				outValue)
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	
+	gLastAllocatedString = inString;
+	outValue->type = kString;
+	outValue->u.str = gLastAllocatedString.c_str();
+}
+
+void
+SetOutputPropertyValue_(
+	IsadoraParameters*	/* ip */,
+	ActorInfo*			/* inActorInfo */,
+	PropertyIndex		inPropertyIndex1,
+	Value*				inValue)
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	
+	gCounters.mOutputChanges++;
+	if (inValue->type == kString && inValue->u.str != NULL) {
+		gOutputs[inPropertyIndex1] = inValue->u.str;
+	}
+}
+
+void
+DrawActorDefinedAreaPict_(
+	IsadoraParameters*	/* ip */,
+	ActorInfo*			/* inActorInfo */,
+	Boolean				/* inSelected */,
+	Rect*				/* inArea */,
+	ActorPictInfo*		/* inPictInfo */)
+{
+}
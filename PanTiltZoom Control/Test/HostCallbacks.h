@@ -0,0 +1,32 @@
+// ===========================================================================
+//	HostCallbacks.h - Isadora callbacks provided by the headless host
+// ===========================================================================
+//
+// HostCallbacks.cpp implements the callback functions declared in
+// Stubs/IsadoraCallbacks.h. Allocations made through IzzyMallocClear_ are
+// counted, and the last value written to each output property is recorded.
+
+#ifndef HOST_CALLBACKS_H
+#define HOST_CALLBACKS_H
+
+#include <IsadoraTypes.h>
+
+#include <string>
+
+typedef struct {
+
+	long	mAllocations;		// IzzyMallocClear_ calls
+	long	mFrees;				// IzzyFree_ calls
+	long	mLiveBytes;			// bytes allocated and not yet freed
+	long	mAssertFailures;	// PluginAssert_ failures
+	long	mOutputChanges;		// SetOutputPropertyValue_ calls
+
+} HostCounters;
+
+void			HostCallbacks_Reset();
+HostCounters	HostCallbacks_GetCounters();
+
+// The last string sent to an output property, or "" if none was sent
+std::string		HostCallbacks_GetOutputString(PropertyIndex inPropertyIndex1);
+
+#endif
@@ -0,0 +1,644 @@
+// ===========================================================================
+//	IzzyHost.cpp - headless Linux host and soak driver for the PTZ actor
+// ===========================================================================
+//
+// Loads a plugin built against the stubs (see README.md) with dlopen, gets its
+// function table through GetActorInfo, creates one actor and replays a script of
+// property changes against the mock NDI cameras. The script can be replayed for
+// a fixed number of iterations or for a fixed time (a soak run). At regular
+// intervals the host reports latency, resident memory and live handle counts,
+// and after DisposeActor it reports every leaked handle. Scripts can also check
+// the actor's behaviour as they go with the expect_* commands.
+//
+// Usage:
+//	IzzyHost [--iterations n] [--duration seconds] [--report seconds] <plugin.so> <script>
+//
+// Script commands, one per line ('#' starts a comment):
+//	set <property> <value>				change an input property
+//	trigger <property>					set a trigger / bool property to 1
+//	wait <milliseconds>					sleep
+//	cameras <n>							number of mock cameras the finder reports (n >= 1)
+//	capture_delay <microseconds>		time each mock capture takes
+//	ndi_init_fails on|off				make NDIlib_initialize fail
+//	recv_create_fails on|off			make NDIlib_recv_create_v3 fail
+//	recreate_actor						dispose the actor and create a new one, as when
+//										a file is closed and reopened
+//	expect_camera <ndi_index>			a PTZ command was sent since the last expect_camera,
+//										and the latest one went to this camera
+//	expect_move <pan> <tilt> <zoom>		the latest PTZ command sent these amounts
+//	expect_output <property> <text>		an output property last received this text
+//	expect_receivers <n>				number of NDI receivers currently alive
+
+#include <IsadoraTypes.h>
+
+#include "HostCallbacks.h"
+#include "MockNDI.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef void (*GetActorInfoProc)(void* inParam, ActorInfo* outActorParams);
+
+typedef std::chrono::steady_clock Clock;
+
+// ---------------------------------------------------------------------------------
+// Properties
+// ---------------------------------------------------------------------------------
+
+typedef struct {
+	std::string		mName;
+	PropertyIndex	mIndex1;
+	ValueType		mType;
+	bool			mIsTrigger;
+	std::string		mInitValue;
+} Property;
+
+// Parses the INPROP or OUTPROP lines of the actor's property definition string
+static std::vector<Property>
+ParseProperties(
+	const char*			inDefinition,
+	const std::string&	inKind)
+{
+	std::vector<Property> props;
+	std::istringstream lines(inDefinition);
+	std::string line;
+
+	while (std::getline(lines, line, '\r')) {
+		std::istringstream fields(line);
+		std::string kind, name, id, type, format, minValue, maxValue, initValue;
+		fields >> kind >> name >> id >> type >> format >> minValue >> maxValue >> initValue;
+
+		if (kind != inKind) {
+			continue;
+		}
+
+		Property prop;
+		prop.mName = name;
+		prop.mIndex1 = (PropertyIndex)(props.size() + 1);
+		prop.mType = type == "int" ? kInteger : type == "float" ? kFloat : type == "bool" ? kBoolean : kString;
+		prop.mIsTrigger = format == "trig";
+		prop.mInitValue = initValue;
+		props.push_back(prop);
+	}
+
+	return props;
+}
+
+static const Property*
+FindProperty(
+	const std::vector<Property>&	inProps,
+	const std::string&				inName)
+{
+	for (size_t i = 0; i < inProps.size(); i++) {
+		if (inProps[i].mName == inName) {
+			return &inProps[i];
+		}
+	}
+	return NULL;
+}
+
+static Value
+MakeValue(
+	ValueType			inType,
+	const std::string&	inText)
+{
+	Value value = Value();
+	value.type = inType;
+
+	switch (inType) {
+		case kInteger:
+		case kBoolean:
+			value.u.ivalue = atoi(inText.c_str());
+			break;
+		case kFloat:
+			value.u.fvalue = (float) atof(inText.c_str());
+			break;
+		default:
+			// string values point into the script, which outlives the run
+			value.u.str = inText.c_str();
+			break;
+	}
+
+	return value;
+}
+
+// ---------------------------------------------------------------------------------
+// Script
+// ---------------------------------------------------------------------------------
+
+enum EventKind {
+	kEventSetProperty,
+	kEventWait,
+	kEventCameras,
+	kEventCaptureDelay,
+	kEventInitFails,
+	kEventRecvCreateFails,
+	kEventRecreateActor,
+	kEventExpectCamera,
+	kEventExpectMove,
+	kEventExpectOutput,
+	kEventExpectReceivers
+};
+
+typedef struct {
+	EventKind		mKind;
+	int				mLine;
+	PropertyIndex	mIndex1;
+	std::string		mText;
+	ValueType		mType;
+	int				mNumber;
+	float			mAmounts[3];
+} ScriptEvent;
+
+static bool
+ParseOnOff(
+	const std::string&	inText,
+	int*				outValue)
+{
+	if (inText == "on") {
+		*outValue = 1;
+	} else if (inText == "off") {
+		*outValue = 0;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+static bool
+LoadScript(
+	const char*						inPath,
+	const std::vector<Property>&	inInputs,
+	const std::vector<Property>&	inOutputs,
+	std::vector<ScriptEvent>*		outEvents)
+{
+	std::ifstream file(inPath);
+	if (!file) {
+		fprintf(stderr, "cannot open script %s\n", inPath);
+		return false;
+	}
+
+	std::string line;
+	int lineNumber = 0;
+
+	while (std::getline(file, line)) {
+		lineNumber++;
+
+		size_t comment = line.find('#');
+		if (comment != std::string::npos) {
+			line.erase(comment);
+		}
+
+		std::istringstream fields(line);
+		std::string command, arg1, arg2;
+		if (!(fields >> command)) {
+			continue;
+		}
+		fields >> arg1;
+		std::getline(fields >> std::ws, arg2);
+		arg2.erase(arg2.find_last_not_of(" \t\r") + 1);
+
+		ScriptEvent event = ScriptEvent();
+		event.mLine = lineNumber;
+		bool ok = true;
+
+		if (command == "set" || command == "trigger") {
+			const Property* prop = FindProperty(inInputs, arg1);
+			ok = prop != NULL && (command == "trigger" || !arg2.empty());
+			if (ok) {
+				event.mKind = kEventSetProperty;
+				event.mIndex1 = prop->mIndex1;
+				event.mType = prop->mType;
+				event.mText = command == "trigger" ? "1" : arg2;
+			}
+		} else if (command == "wait") {
+			event.mKind = kEventWait;
+			event.mNumber = atoi(arg1.c_str());
+		} else if (command == "cameras") {
+			// the actor waits for sources forever when there are none, so
+			// a run without cameras would never finish
+			event.mKind = kEventCameras;
+			event.mNumber = atoi(arg1.c_str());
+			ok = event.mNumber >= 1;
+		} else if (command == "capture_delay") {
+			event.mKind = kEventCaptureDelay;
+			event.mNumber = atoi(arg1.c_str());
+		} else if (command == "ndi_init_fails") {
+			event.mKind = kEventInitFails;
+			ok = ParseOnOff(arg1, &event.mNumber);
+		} else if (command == "recv_create_fails") {
+			event.mKind = kEventRecvCreateFails;
+			ok = ParseOnOff(arg1, &event.mNumber);
+		} else if (command == "recreate_actor") {
+			event.mKind = kEventRecreateActor;
+		} else if (command == "expect_receivers") {
+			event.mKind = kEventExpectReceivers;
+			event.mNumber = atoi(arg1.c_str());
+			ok = !arg1.empty();
+		} else if (command == "expect_camera") {
+			event.mKind = kEventExpectCamera;
+			event.mNumber = atoi(arg1.c_str());
+			ok = !arg1.empty();
+		} else if (command == "expect_move") {
+			event.mKind = kEventExpectMove;
+			std::istringstream amounts(arg1 + " " + arg2);
+			ok = !!(amounts >> event.mAmounts[0] >> event.mAmounts[1] >> event.mAmounts[2]);
+		} else if (command == "expect_output") {
+			const Property* prop = FindProperty(inOutputs, arg1);
+			ok = prop != NULL;
+			if (ok) {
+				event.mKind = kEventExpectOutput;
+				event.mIndex1 = prop->mIndex1;
+				event.mText = arg2;
+			}
+		} else {
+			ok = false;
+		}
+
+		if (!ok) {
+			fprintf(stderr, "%s:%d: cannot parse '%s'\n", inPath, lineNumber, line.c_str());
+			return false;
+		}
+
+		outEvents->push_back(event);
+	}
+
+	return true;
+}
+
+// ---------------------------------------------------------------------------------
+// Expectations
+// ---------------------------------------------------------------------------------
+
+static const long	kMaxReportedFailures = 10;
+
+static long			gExpectFailures = 0;
+static long			gPanTiltCallsAtLastCheck = 0;
+
+static void
+ExpectFailed(
+	const ScriptEvent&	inEvent,
+	const std::string&	inMessage)
+{
+	gExpectFailures++;
+	if (gExpectFailures <= kMaxReportedFailures) {
+		fprintf(stderr, "script line %d: %s\n", inEvent.mLine, inMessage.c_str());
+	}
+}
+
+static void
+CheckExpectation(
+	const ScriptEvent&	inEvent)
+{
+	MockNDICounters ndi = MockNDI_GetCounters();
+	char message[256];
+
+	switch (inEvent.mKind) {
+		case kEventExpectCamera:
+			if (ndi.mPanTiltCalls == gPanTiltCallsAtLastCheck) {
+				ExpectFailed(inEvent, "expected a PTZ command, none was sent");
+			} else if (ndi.mLastCamera != inEvent.mNumber) {
+				snprintf(message, sizeof(message), "expected PTZ command to camera %d, went to camera %d", inEvent.mNumber, ndi.mLastCamera);
+				ExpectFailed(inEvent, message);
+			}
+			gPanTiltCallsAtLastCheck = ndi.mPanTiltCalls;
+			break;
+		case kEventExpectMove:
+			if (ndi.mLastPan != inEvent.mAmounts[0] || ndi.mLastTilt != inEvent.mAmounts[1] || ndi.mLastZoom != inEvent.mAmounts[2]) {
+				snprintf(message, sizeof(message), "expected move %g %g %g, got %g %g %g",
+					inEvent.mAmounts[0], inEvent.mAmounts[1], inEvent.mAmounts[2], ndi.mLastPan, ndi.mLastTilt, ndi.mLastZoom);
+				ExpectFailed(inEvent, message);
+			}
+			break;
+		case kEventExpectOutput:
+		{
+			std::string output = HostCallbacks_GetOutputString(inEvent.mIndex1);
+			if (output != inEvent.mText) {
+				ExpectFailed(inEvent, "expected output '" + inEvent.mText + "', got '" + output + "'");
+			}
+			break;
+		}
+		case kEventExpectReceivers:
+		{
+			long live = ndi.mReceiversCreated - ndi.mReceiversDestroyed;
+			if (live != inEvent.mNumber) {
+				snprintf(message, sizeof(message), "expected %d live receivers, found %ld", inEvent.mNumber, live);
+				ExpectFailed(inEvent, message);
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+// ---------------------------------------------------------------------------------
+// Actor lifecycle
+// ---------------------------------------------------------------------------------
+
+// Creates the actor and sends it its initial values, the way Isadora does
+static void
+StartActor(
+	IsadoraParameters*				ip,
+	ActorInfo*						ioActor,
+	const std::vector<Property>&	inProps,
+	std::vector<Value>*				ioCurrent)
+{
+	ioActor->mCreateActorProc(ip, ioActor);
+
+	for (size_t i = 0; i < inProps.size(); i++) {
+		Value initValue = MakeValue(inProps[i].mType, inProps[i].mInitValue);
+		(*ioCurrent)[inProps[i].mIndex1] = initValue;
+		if (!inProps[i].mIsTrigger) {
+			ioActor->mHandlePropertyChangeValueProc(ip, ioActor, inProps[i].mIndex1, &initValue, &initValue, true);
+		}
+	}
+
+	ioActor->mActivateActorProc(ip, ioActor, true);
+}
+
+static void
+StopActor(
+	IsadoraParameters*				ip,
+	ActorInfo*						ioActor)
+{
+	ioActor->mActivateActorProc(ip, ioActor, false);
+	ioActor->mDisposeActorProc(ip, ioActor);
+}
+
+// ---------------------------------------------------------------------------------
+// Measurements
+// ---------------------------------------------------------------------------------
+
+typedef struct {
+	long	mEvents;
+	double	mTotalMicros;
+	double	mMaxMicros;
+} LatencyWindow;
+
+static long
+ResidentKB()
+{
+	long pages = 0;
+	long resident = 0;
+
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if (statm == NULL) {
+		return 0;
+	}
+	if (fscanf(statm, "%ld %ld", &pages, &resident) != 2) {
+		resident = 0;
+	}
+	fclose(statm);
+
+	return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static void
+PrintReportHeader()
+{
+	printf("%10s %10s %12s %10s %10s %10s %10s %10s %8s %8s %6s\n",
+		"elapsed_s", "iteration", "events", "mean_us", "max_us", "drift_us",
+		"rss_kb", "rss_grow", "finders", "recvs", "stale");
+}
+
+static void
+PrintReport(
+	double					inElapsed,
+	long					inIteration,
+	const LatencyWindow&	inWindow,
+	double					inBaselineMean,
+	long					inBaselineRSS)
+{
+	MockNDICounters ndi = MockNDI_GetCounters();
+
+	double mean = inWindow.mEvents > 0 ? inWindow.mTotalMicros / inWindow.mEvents : 0;
+	long rss = ResidentKB();
+
+	printf("%10.0f %10ld %12ld %10.1f %10.1f %+10.1f %10ld %+10ld %8ld %8ld %6ld\n",
+		inElapsed, inIteration, inWindow.mEvents, mean, inWindow.mMaxMicros, mean - inBaselineMean,
+		rss, rss - inBaselineRSS,
+		ndi.mFindersCreated - ndi.mFindersDestroyed,
+		ndi.mReceiversCreated - ndi.mReceiversDestroyed,
+		ndi.mStaleReceiverUses);
+	fflush(stdout);
+}
+
+// ---------------------------------------------------------------------------------
+// main
+// ---------------------------------------------------------------------------------
+
+static void
+Usage()
+{
+	fprintf(stderr, "usage: IzzyHost [--iterations n] [--duration seconds] [--report seconds] <plugin.so> <script>\n");
+}
+
+int
+main(
+	int			argc,
+	char**		argv)
+{
+	long iterations = 1;
+	double duration = 0;
+	double reportInterval = 60;
+	const char* pluginPath = NULL;
+	const char* scriptPath = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+			iterations = atol(argv[++i]);
+		} else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+			duration = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+			reportInterval = atof(argv[++i]);
+		} else if (pluginPath == NULL) {
+			pluginPath = argv[i];
+		} else if (scriptPath == NULL) {
+			scriptPath = argv[i];
+		} else {
+			Usage();
+			return 2;
+		}
+	}
+
+	if (pluginPath == NULL || scriptPath == NULL || reportInterval <= 0) {
+		Usage();
+		return 2;
+	}
+
+	// load the plugin and get its function table
+	void* plugin = dlopen(pluginPath, RTLD_NOW | RTLD_LOCAL);
+	if (plugin == NULL) {
+		fprintf(stderr, "cannot load %s: %s\n", pluginPath, dlerror());
+		return 2;
+	}
+
+	GetActorInfoProc getActorInfo = (GetActorInfoProc) dlsym(plugin, "GetActorInfo");
+	if (getActorInfo == NULL) {
+		fprintf(stderr, "%s does not export GetActorInfo\n", pluginPath);
+		return 2;
+	}
+
+	IsadoraParameters ip = IsadoraParameters();
+	ActorInfo actor = ActorInfo();
+	getActorInfo(NULL, &actor);
+
+	const char* definition = actor.mGetActorParameterStringProc(&ip, &actor);
+	std::vector<Property> props = ParseProperties(definition, "INPROP");
+	std::vector<Property> outputs = ParseProperties(definition, "OUTPROP");
+
+	std::vector<ScriptEvent> events;
+	if (!LoadScript(scriptPath, props, outputs, &events)) {
+		return 2;
+	}
+
+	printf("actor '%s' from %s, %zu input properties, %zu script events\n",
+		actor.mActorName, pluginPath, props.size(), events.size());
+
+	// current value of every input, passed as the old value of the next change
+	std::vector<Value> current(props.size() + 1);
+
+	StartActor(&ip, &actor, props, &current);
+
+	// replay the script
+	PrintReportHeader();
+
+	Clock::time_point start = Clock::now();
+	Clock::time_point nextReport = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(reportInterval));
+
+	LatencyWindow window = LatencyWindow();
+	double baselineMean = -1;
+	long baselineRSS = -1;
+	long iteration = 0;
+
+	for (;;) {
+
+		double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+		if (duration > 0 ? elapsed >= duration : iteration >= iterations) {
+			break;
+		}
+
+		for (size_t i = 0; i < events.size(); i++) {
+			const ScriptEvent& event = events[i];
+
+			switch (event.mKind) {
+				case kEventSetProperty:
+				{
+					Value newValue = MakeValue(event.mType, event.mText);
+					Value oldValue = current[event.mIndex1];
+
+					Clock::time_point before = Clock::now();
+					actor.mHandlePropertyChangeValueProc(&ip, &actor, event.mIndex1, &oldValue, &newValue, false);
+					double micros = std::chrono::duration<double, std::micro>(Clock::now() - before).count();
+
+					current[event.mIndex1] = newValue;
+
+					window.mEvents++;
+					window.mTotalMicros += micros;
+					if (micros > window.mMaxMicros) {
+						window.mMaxMicros = micros;
+					}
+					break;
+				}
+				case kEventWait:
+					std::this_thread::sleep_for(std::chrono::milliseconds(event.mNumber));
+					break;
+				case kEventCameras:
+					MockNDI_SetCameraCount(event.mNumber);
+					break;
+				case kEventCaptureDelay:
+					MockNDI_SetCaptureDelayMicros(event.mNumber);
+					break;
+				case kEventInitFails:
+					MockNDI_SetInitializeFails(event.mNumber != 0);
+					break;
+				case kEventRecvCreateFails:
+					MockNDI_SetReceiverCreateFails(event.mNumber != 0);
+					break;
+				case kEventRecreateActor:
+					StopActor(&ip, &actor);
+					StartActor(&ip, &actor, props, &current);
+					break;
+				case kEventExpectCamera:
+				case kEventExpectMove:
+				case kEventExpectOutput:
+				case kEventExpectReceivers:
+					CheckExpectation(event);
+					break;
+			}
+		}
+
+		iteration++;
+
+		// the first window is the baseline that memory growth and latency drift
+		// are measured against
+		if (Clock::now() >= nextReport) {
+			double mean = window.mEvents > 0 ? window.mTotalMicros / window.mEvents : 0;
+			if (baselineMean < 0) {
+				baselineMean = mean;
+				baselineRSS = ResidentKB();
+			}
+
+			PrintReport(std::chrono::duration<double>(Clock::now() - start).count(), iteration, window, baselineMean, baselineRSS);
+
+			window = LatencyWindow();
+			while (nextReport <= Clock::now()) {
+				nextReport += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(reportInterval));
+			}
+		}
+	}
+
+	if (window.mEvents > 0 || baselineMean < 0) {
+		double mean = window.mEvents > 0 ? window.mTotalMicros / window.mEvents : 0;
+		if (baselineMean < 0) {
+			baselineMean = mean;
+			baselineRSS = ResidentKB();
+		}
+		PrintReport(std::chrono::duration<double>(Clock::now() - start).count(), iteration, window, baselineMean, baselineRSS);
+	}
+
+	// tear down and look for anything left behind
+	MockNDI_SetInitializeFails(false);
+	MockNDI_SetReceiverCreateFails(false);
+
+	StopActor(&ip, &actor);
+
+	MockNDICounters ndi = MockNDI_GetCounters();
+	HostCounters host = HostCallbacks_GetCounters();
+
+	long leakedReceivers = ndi.mReceiversCreated - ndi.mReceiversDestroyed;
+	long leakedFinders = ndi.mFindersCreated - ndi.mFindersDestroyed;
+	long leakedLibraries = ndi.mInitializeSucceeded - (ndi.mDestroyCalls - ndi.mDestroyWithoutInit);
+
+	printf("\nafter DisposeActor:\n");
+	printf("  receivers      %ld created, %ld destroyed, %ld leaked\n", ndi.mReceiversCreated, ndi.mReceiversDestroyed, leakedReceivers);
+	printf("  finders        %ld created, %ld destroyed, %ld leaked\n", ndi.mFindersCreated, ndi.mFindersDestroyed, leakedFinders);
+	printf("  NDI library    %ld initialized, %ld destroyed, %ld unmatched destroys\n", ndi.mInitializeSucceeded, ndi.mDestroyCalls, ndi.mDestroyWithoutInit);
+	printf("  stale uses     %ld calls with a destroyed receiver\n", ndi.mStaleReceiverUses);
+	printf("  plugin memory  %ld allocations, %ld frees, %ld bytes leaked\n", host.mAllocations, host.mFrees, host.mLiveBytes);
+	printf("  asserts        %ld failed\n", host.mAssertFailures);
+	printf("  NDI calls      %ld initialize, %ld capture, %ld pan/tilt, %ld zoom\n", ndi.mInitializeCalls, ndi.mCaptureCalls, ndi.mPanTiltCalls, ndi.mZoomCalls);
+	printf("  outputs        %ld changes\n", host.mOutputChanges);
+	printf("  expectations   %ld failed\n", gExpectFailures);
+
+	bool leaks = leakedReceivers != 0 || leakedFinders != 0 || leakedLibraries != 0
+		|| ndi.mDestroyWithoutInit != 0 || ndi.mStaleReceiverUses != 0
+		|| host.mLiveBytes != 0 || host.mAssertFailures != 0;
+	bool clean = !leaks && gExpectFailures == 0;
+
+	printf("%s\n", clean ? "CLEAN" : leaks ? "LEAKS FOUND" : "EXPECTATIONS FAILED");
+
+	dlclose(plugin);
+	return clean ? 0 : 1;
+}
@@ -0,0 +1,336 @@
+// ===========================================================================
+//	MockNDI.cpp - simulated NDI cameras for the headless tests
+// ===========================================================================
+
+#include "MockNDI.h"
+
+#include <processing.NDI.Lib.h>
+
+#include <stdio.h>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------------
+// Mock handles
+// ---------------------------------------------------------------------------------
+
+typedef struct {
+	std::vector<std::string>		mNames;
+	std::vector<NDIlib_source_t>	mSources;
+} MockFinder;
+
+// Receivers are plain tokens that are never reused, so a call made with a
+// receiver that was already destroyed can always be told apart from a live one,
+// even after its memory would have been recycled.
+static uintptr_t			gNextReceiverToken = 0x1000;
+
+// ---------------------------------------------------------------------------------
+// State
+// ---------------------------------------------------------------------------------
+
+static std::mutex			gMutex;
+static MockNDICounters		gCounters;
+static std::set<void*>		gLiveFinders;
+static std::map<void*, int>	gLiveReceivers;			// receiver token -> camera index
+static int					gLibInitCount = 0;
+
+static int					gCameraCount = 4;
+static int					gCaptureDelayMicros = 0;
+static bool					gInitializeFails = false;
+static bool					gReceiverCreateFails = false;
+
+// Returns the camera index of a live receiver, or -1 (and counts a stale use)
+static int
+UseReceiver(
+	NDIlib_recv_instance_t	inRecv)
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	
+	std::map<void*, int>::const_iterator it = gLiveReceivers.find(inRecv);
+	if (it == gLiveReceivers.end()) {
+		gCounters.mStaleReceiverUses++;
+		return -1;
+	}
+	
+	return it->second;
+}
+
+// ---------------------------------------------------------------------------------
+// Control
+// ---------------------------------------------------------------------------------
+
+void
+MockNDI_Reset()
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	
+	gCounters = MockNDICounters();
+	gLiveFinders.clear();
+	gLiveReceivers.clear();
+	gLibInitCount = 0;
+	
+	gCameraCount = 4;
+	gCaptureDelayMicros = 0;
+	gInitializeFails = false;
+	gReceiverCreateFails = false;
+}
+
+void
+MockNDI_SetCameraCount(
+	int		inCount)
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	gCameraCount = inCount;
+}
+
+void
+MockNDI_SetCaptureDelayMicros(
+	int		inMicros)
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	gCaptureDelayMicros = inMicros;
+}
+
+void
+MockNDI_SetInitializeFails(
+	bool	inFails)
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	gInitializeFails = inFails;
+}
+
+void
+MockNDI_SetReceiverCreateFails(
+	bool	inFails)
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	gReceiverCreateFails = inFails;
+}
+
+MockNDICounters
+MockNDI_GetCounters()
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	return gCounters;
+}
+
+// ---------------------------------------------------------------------------------
+// Library
+// ---------------------------------------------------------------------------------
+
+bool
+NDIlib_initialize(void)
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	
+	gCounters.mInitializeCalls++;
+	if (gInitializeFails) {
+		return false;
+	}
+	
+	gCounters.mInitializeSucceeded++;
+	gLibInitCount++;
+	return true;
+}
+
+void
+NDIlib_destroy(void)
+{
+	std::lock_guard<std::mutex> lock(gMutex);
+	
+	gCounters.mDestroyCalls++;
+	if (gLibInitCount == 0) {
+		gCounters.mDestroyWithoutInit++;
+	} else {
+		gLibInitCount--;
+	}
+}
+
+// ---------------------------------------------------------------------------------
+// Finder
+// ---------------------------------------------------------------------------------
+
+NDIlib_find_instance_t
+NDIlib_find_create_v2(
+	const NDIlib_find_create_t*	/* p_create_settings */)
+{
+	MockFinder* finder = new MockFinder;
+	
+	std::lock_guard<std::mutex> lock(gMutex);
+	
+	for (int i = 0; i < gCameraCount; i++) {
+		char name[64];
+		snprintf(name, sizeof(name), "MOCK-PTZ (Camera %d)", i + 1);
+		finder->mNames.push_back(name);
+	}
+	
+	for (size_t i = 0; i < finder->mNames.size(); i++) {
+		NDIlib_source_t source = { finder->mNames[i].c_str(), NULL };
+		finder->mSources.push_back(source);
+	}
+	
+	gCounters.mFindersCreated++;
+	gLiveFinders.insert(finder);
+	return finder;
+}
+
+void
+NDIlib_find_destroy(
+	NDIlib_find_instance_t	p_instance)
+{
+	if (p_instance == NULL) {
+		return;
+	}
+	
+	std::lock_guard<std::mutex> lock(gMutex);
+	
+	if (gLiveFinders.erase(p_instance) == 0) {
+		fprintf(stderr, "MockNDI: destroying unknown finder %p\n", p_instance);
+		return;
+	}
+	
+	gCounters.mFindersDestroyed++;
+	delete static_cast<MockFinder*>(p_instance);
+}
+
+bool
+NDIlib_find_wait_for_sources(
+	NDIlib_find_instance_t	/* p_instance */,
+	uint32_t				/* timeout_in_ms */)
+{
+	return true;
+}
+
+const NDIlib_source_t*
+NDIlib_find_get_current_sources(
+	NDIlib_find_instance_t	p_instance,
+	uint32_t*				p_no_sources)
+{
+	MockFinder* finder = static_cast<MockFinder*>(p_instance);
+	
+	*p_no_sources = (uint32_t) finder->mSources.size();
+	return finder->mSources.empty() ? NULL : &finder->mSources[0];
+}
+
+// ---------------------------------------------------------------------------------
+// Receiver
+// ---------------------------------------------------------------------------------
+
+NDIlib_recv_instance_t
+NDIlib_recv_create_v3(
+	const NDIlib_recv_create_v3_t*	p_create_settings)
+{
+	int camera = -1;
+	sscanf(p_create_settings->source_to_connect_to.p_ndi_name, "MOCK-PTZ (Camera %d)", &camera);
+	
+	std::lock_guard<std::mutex> lock(gMutex);
+	
+	if (gReceiverCreateFails) {
+		return NULL;
+	}
+	
+	void* recv = reinterpret_cast<void*>(gNextReceiverToken);
+	gNextReceiverToken += 16;
+	
+	gCounters.mReceiversCreated++;
+	gLiveReceivers[recv] = camera - 1;
+	return recv;
+}
+
+void
+NDIlib_recv_destroy(
+	NDIlib_recv_instance_t	p_instance)
+{
+	if (p_instance == NULL) {
+		return;
+	}
+	
+	std::lock_guard<std::mutex> lock(gMutex);
+	
+	if (gLiveReceivers.erase(p_instance) == 0) {
+		gCounters.mStaleReceiverUses++;
+		return;
+	}
+	
+	gCounters.mReceiversDestroyed++;
+}
+
+NDIlib_frame_type_e
+NDIlib_recv_capture_v3(
+	NDIlib_recv_instance_t		p_instance,
+	NDIlib_video_frame_v2_t*	/* p_video_data */,
+	NDIlib_audio_frame_v3_t*	/* p_audio_data */,
+	NDIlib_metadata_frame_t*	/* p_metadata */,
+	uint32_t					/* timeout_in_ms */)
+{
+	int delay;
+	{
+		std::lock_guard<std::mutex> lock(gMutex);
+		gCounters.mCaptureCalls++;
+		delay = gCaptureDelayMicros;
+	}
+	
+	if (UseReceiver(p_instance) < 0) {
+		return NDIlib_frame_type_error;
+	}
+	
+	if (delay > 0) {
+		std::this_thread::sleep_for(std::chrono::microseconds(delay));
+	}
+	
+	// touch the receiver again after the wait, the way the real library keeps using
+	// its connection - this is where a receiver destroyed mid-capture shows up
+	if (UseReceiver(p_instance) < 0) {
+		return NDIlib_frame_type_error;
+	}
+	
+	return NDIlib_frame_type_status_change;
+}
+
+bool
+NDIlib_recv_ptz_is_supported(
+	NDIlib_recv_instance_t	p_instance)
+{
+	return UseReceiver(p_instance) >= 0;
+}
+
+bool
+NDIlib_recv_ptz_pan_tilt(
+	NDIlib_recv_instance_t	p_instance,
+	const float				pan_speed,
+	const float				tilt_speed)
+{
+	int camera = UseReceiver(p_instance);
+	if (camera < 0) {
+		return false;
+	}
+	
+	std::lock_guard<std::mutex> lock(gMutex);
+	gCounters.mPanTiltCalls++;
+	gCounters.mLastPan = pan_speed;
+	gCounters.mLastTilt = tilt_speed;
+	gCounters.mLastCamera = camera;
+	return true;
+}
+
+bool
+NDIlib_recv_ptz_zoom(
+	NDIlib_recv_instance_t	p_instance,
+	const float				zoom_speed)
+{
+	int camera = UseReceiver(p_instance);
+	if (camera < 0) {
+		return false;
+	}
+	
+	std::lock_guard<std::mutex> lock(gMutex);
+	gCounters.mZoomCalls++;
+	gCounters.mLastZoom = zoom_speed;
+	gCounters.mLastCamera = camera;
+	return true;
+}
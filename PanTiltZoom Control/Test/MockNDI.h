@@ -0,0 +1,53 @@
+// ===========================================================================
+//	MockNDI.h - simulated NDI cameras for the headless tests
+// ===========================================================================
+//
+// MockNDI.cpp implements the NDIlib_* functions declared in
+// Stubs/processing.NDI.Lib.h. It simulates a configurable number of PTZ cameras
+// and counts every library, finder and receiver handle so that the tests can
+// report leaks and uses of receivers that were already destroyed.
+
+#ifndef MOCK_NDI_H
+#define MOCK_NDI_H
+
+typedef struct {
+
+	long	mInitializeCalls;		// calls to NDIlib_initialize (including failed ones)
+	long	mInitializeSucceeded;	// calls to NDIlib_initialize that returned true
+	long	mDestroyCalls;			// calls to NDIlib_destroy
+	long	mDestroyWithoutInit;	// NDIlib_destroy calls with the library not initialized
+	
+	long	mFindersCreated;
+	long	mFindersDestroyed;
+	
+	long	mReceiversCreated;
+	long	mReceiversDestroyed;
+	long	mStaleReceiverUses;		// calls made with a receiver that was never created or already destroyed
+	
+	long	mCaptureCalls;
+	long	mPanTiltCalls;
+	long	mZoomCalls;
+	
+	float	mLastPan;
+	float	mLastTilt;
+	float	mLastZoom;
+	int		mLastCamera;			// index of the camera that received the last PTZ command
+	
+} MockNDICounters;
+
+// Resets all counters and settings. Must not be called while handles are alive.
+void	MockNDI_Reset();
+
+// Number of cameras reported by the finder (default 4)
+void	MockNDI_SetCameraCount(int inCount);
+
+// Time NDIlib_recv_capture_v3 takes before reporting a status change (default 0)
+void	MockNDI_SetCaptureDelayMicros(int inMicros);
+
+// Makes NDIlib_initialize / NDIlib_recv_create_v3 fail until set back to false
+void	MockNDI_SetInitializeFails(bool inFails);
+void	MockNDI_SetReceiverCreateFails(bool inFails);
+
+MockNDICounters	MockNDI_GetCounters();
+
+#endif
@@ -0,0 +1,10 @@
+// ===========================================================================
+//	ImageBufferUtil.h - headless test stub
+// ===========================================================================
+//
+// NDIPTZControl.cpp does not process video, so nothing is needed from here.
+
+#ifndef IMAGE_BUFFER_UTIL_STUB_H
+#define IMAGE_BUFFER_UTIL_STUB_H
+
+#endif
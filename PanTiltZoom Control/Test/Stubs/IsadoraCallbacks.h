@@ -0,0 +1,24 @@
+// ===========================================================================
+//	IsadoraCallbacks.h - headless test stub
+// ===========================================================================
+//
+// In the real SDK these are macros that call through ip->mCallbacks. Here they
+// are plain functions implemented by the headless host (see HostCallbacks.cpp).
+
+#ifndef ISADORA_CALLBACKS_STUB_H
+#define ISADORA_CALLBACKS_STUB_H
+
+#include "IsadoraTypes.h"
+
+void*	IzzyMallocClear_(IsadoraParameters* ip, size_t inSize);
+void	IzzyFree_(IsadoraParameters* ip, void* inPtr);
+
+void	HostPluginAssert(bool inCondition, const char* inExpression, const char* inFile, int inLine);
+#define PluginAssert_(ip, cond)		HostPluginAssert((cond), #cond, __FILE__, __LINE__)
+
+UInt32	PropertyTypeAndIndexToHelpIndex_(IsadoraParameters* ip, ActorInfo* inActorInfo, PropertyType inPropertyType, PropertyIndex inPropertyIndex1);
+
+void	AllocateValueString_(IsadoraParameters* ip, const char* inString, Value* outValue);
+void	SetOutputPropertyValue_(IsadoraParameters* ip, ActorInfo* inActorInfo, PropertyIndex inPropertyIndex1, Value* inValue);
+
+#endif
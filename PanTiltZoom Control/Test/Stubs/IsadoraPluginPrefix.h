@@ -0,0 +1,19 @@
+// ===========================================================================
+//	IsadoraPluginPrefix.h - headless test stub
+// ===========================================================================
+//
+// Stand-in for the IzzySDK prefix header so NDIPTZControl.cpp can be built on
+// Linux outside of Isadora. Only what the plugin uses is declared here.
+
+#ifndef ISADORA_PLUGIN_PREFIX_STUB_H
+#define ISADORA_PLUGIN_PREFIX_STUB_H
+
+#define TARGET_OS_MAC		0
+#define TARGET_OS_WIN		0
+#define TARGET_OS_LINUX		1
+
+#ifndef nil
+#define nil					0
+#endif
+
+#endif
@@ -0,0 +1,117 @@
+// ===========================================================================
+//	IsadoraTypes.h - headless test stub
+// ===========================================================================
+//
+// The subset of the IzzySDK types used by NDIPTZControl.cpp. Layouts are not
+// binary compatible with the real SDK; they only need to agree between the
+// plugin and the headless host built from the same stubs.
+
+#ifndef ISADORA_TYPES_STUB_H
+#define ISADORA_TYPES_STUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned char		Boolean;
+typedef uint32_t			OSType;
+typedef uint32_t			UInt32;
+typedef int32_t				SInt32;
+typedef int16_t				SInt16;
+
+#define FOUR_CHAR_CODE(x)	((OSType)(x))
+
+typedef UInt32				PropertyIndex;
+typedef void*				MessageReceiverRef;
+typedef UInt32				ActorAreaDrawFlagsT;
+
+typedef struct {
+	SInt16	top;
+	SInt16	left;
+	SInt16	bottom;
+	SInt16	right;
+} Rect;
+
+enum PropertyType {
+	kPropertyTypeInvalid = 0,
+	kInputProperty,
+	kOutputProperty
+};
+
+enum ActorDefinedAreaPart {
+	kActorDefinedAreaTop = 0,
+	kActorDefinedAreaBottom
+};
+
+// Actor Types
+enum {
+	kGroupControl = 0x6374726C		// 'ctrl'
+};
+
+enum {
+	kCurrentIsadoraCallbackVersion = 1
+};
+
+enum {
+	kActorFlags_Plugin_CheckForUpdates = 0x0001
+};
+
+// Values
+enum ValueType {
+	kInteger = 0,
+	kFloat,
+	kBoolean,
+	kString
+};
+
+typedef struct {
+	ValueType	type;
+	union {
+		SInt32		ivalue;
+		float		fvalue;
+		const char*	str;
+	} u;
+} Value;
+
+typedef Value* ValuePtr;
+
+typedef struct {
+	void*	mCallbacks;		// unused by the headless host
+} IsadoraParameters;
+
+struct ActorInfo;
+
+typedef const char*	(*GetActorParameterStringProc)(IsadoraParameters*, ActorInfo*);
+typedef void		(*GetActorHelpStringProc)(IsadoraParameters*, ActorInfo*, PropertyType, PropertyIndex, char*, UInt32);
+typedef void		(*CreateActorProc)(IsadoraParameters*, ActorInfo*);
+typedef void		(*DisposeActorProc)(IsadoraParameters*, ActorInfo*);
+typedef void		(*ActivateActorProc)(IsadoraParameters*, ActorInfo*, Boolean);
+typedef void		(*HandlePropertyChangeValueProc)(IsadoraParameters*, ActorInfo*, PropertyIndex, ValuePtr, ValuePtr, Boolean);
+typedef Boolean		(*GetActorDefinedAreaProc)(IsadoraParameters*, ActorInfo*, SInt16*, SInt16*, SInt16*, SInt16*);
+typedef void		(*DrawActorDefinedAreaProc)(IsadoraParameters*, ActorInfo*, void*, ActorDefinedAreaPart, ActorAreaDrawFlagsT, Rect*, Rect*, Boolean);
+
+struct ActorInfo {
+	void*							mActorDataPtr;
+	
+	const char*						mActorName;
+	OSType							mClass;
+	OSType							mID;
+	UInt32							mCompatibleWithVersion;
+	UInt32							mActorFlags;
+	
+	GetActorParameterStringProc		mGetActorParameterStringProc;
+	GetActorHelpStringProc			mGetActorHelpStringProc;
+	CreateActorProc					mCreateActorProc;
+	DisposeActorProc				mDisposeActorProc;
+	ActivateActorProc				mActivateActorProc;
+	HandlePropertyChangeValueProc	mHandlePropertyChangeValueProc;
+	
+	void*							mHandlePropertyChangeTypeProc;
+	void*							mHandlePropertyConnectProc;
+	void*							mPropertyValueToStringProc;
+	void*							mPropertyStringToValueProc;
+	GetActorDefinedAreaProc			mGetActorDefinedAreaProc;
+	DrawActorDefinedAreaProc		mDrawActorDefinedAreaProc;
+	void*							mMouseTrackInActorDefinedAreaProc;
+};
+
+#endif
@@ -0,0 +1,20 @@
+// ===========================================================================
+//	PluginDrawUtil.h - headless test stub
+// ===========================================================================
+
+#ifndef PLUGIN_DRAW_UTIL_STUB_H
+#define PLUGIN_DRAW_UTIL_STUB_H
+
+#include "IsadoraTypes.h"
+
+typedef struct {
+	bool		mInitialized;
+	void*		mPict;
+	void*		mMask;
+	SInt16		mWidth;
+	SInt16		mHeight;
+} ActorPictInfo;
+
+void	DrawActorDefinedAreaPict_(IsadoraParameters* ip, ActorInfo* inActorInfo, Boolean inSelected, Rect* inArea, ActorPictInfo* inPictInfo);
+
+#endif
@@ -0,0 +1,61 @@
+// ===========================================================================
+//	processing.NDI.Lib.h - headless test stub
+// ===========================================================================
+//
+// The subset of the NDI SDK used by NDIPTZControl.cpp. The functions are
+// implemented by the mock NDI layer in MockNDI.cpp, which simulates cameras and
+// counts every handle it hands out.
+
+#ifndef PROCESSING_NDI_LIB_STUB_H
+#define PROCESSING_NDI_LIB_STUB_H
+
+#include <stdint.h>
+
+typedef void* NDIlib_find_instance_t;
+typedef void* NDIlib_recv_instance_t;
+
+typedef struct NDIlib_video_frame_v2_t NDIlib_video_frame_v2_t;
+typedef struct NDIlib_audio_frame_v3_t NDIlib_audio_frame_v3_t;
+typedef struct NDIlib_metadata_frame_t NDIlib_metadata_frame_t;
+
+typedef struct {
+	const char*		p_ndi_name;
+	const char*		p_url_address;
+} NDIlib_source_t;
+
+typedef struct {
+	bool			show_local_sources;
+	const char*		p_groups;
+	const char*		p_extra_ips;
+} NDIlib_find_create_t;
+
+typedef struct {
+	NDIlib_source_t	source_to_connect_to;
+	const char*		p_ndi_recv_name;
+} NDIlib_recv_create_v3_t;
+
+typedef enum {
+	NDIlib_frame_type_none = 0,
+	NDIlib_frame_type_video = 1,
+	NDIlib_frame_type_audio = 2,
+	NDIlib_frame_type_metadata = 3,
+	NDIlib_frame_type_error = 4,
+	NDIlib_frame_type_status_change = 100
+} NDIlib_frame_type_e;
+
+bool					NDIlib_initialize(void);
+void					NDIlib_destroy(void);
+
+NDIlib_find_instance_t	NDIlib_find_create_v2(const NDIlib_find_create_t* p_create_settings);
+void					NDIlib_find_destroy(NDIlib_find_instance_t p_instance);
+bool					NDIlib_find_wait_for_sources(NDIlib_find_instance_t p_instance, uint32_t timeout_in_ms);
+const NDIlib_source_t*	NDIlib_find_get_current_sources(NDIlib_find_instance_t p_instance, uint32_t* p_no_sources);
+
+NDIlib_recv_instance_t	NDIlib_recv_create_v3(const NDIlib_recv_create_v3_t* p_create_settings);
+void					NDIlib_recv_destroy(NDIlib_recv_instance_t p_instance);
+NDIlib_frame_type_e		NDIlib_recv_capture_v3(NDIlib_recv_instance_t p_instance, NDIlib_video_frame_v2_t* p_video_data, NDIlib_audio_frame_v3_t* p_audio_data, NDIlib_metadata_frame_t* p_metadata, uint32_t timeout_in_ms);
+bool					NDIlib_recv_ptz_is_supported(NDIlib_recv_instance_t p_instance);
+bool					NDIlib_recv_ptz_pan_tilt(NDIlib_recv_instance_t p_instance, const float pan_speed, const float tilt_speed);
+bool					NDIlib_recv_ptz_zoom(NDIlib_recv_instance_t p_instance, const float zoom_speed);
+
+#endif
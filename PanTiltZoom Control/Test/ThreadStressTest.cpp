@@ -0,0 +1,176 @@
+// ===========================================================================
+//	ThreadStressTest.cpp - ThreadSanitizer stress test for the cross-thread state
+// ===========================================================================
+//
+// Hammers the two pieces of PluginInfo that are shared between the Isadora
+// callback thread and worker threads:
+//
+//	- the PTZ seqlock: one writer, several readers; a reader must never see a
+//	  triple made of values from different writes.
+//	- the NDI receiver handle: the "Isadora thread" keeps changing ndi_index while
+//	  workers keep triggering moves; no worker may ever use a receiver that has
+//	  already been destroyed.
+//
+// ThreadSanitizer checks the seqlock and the hazard slots themselves. It cannot
+// see receiver lifetime bugs, because the mock NDI layer serializes every call on
+// its own mutex and receivers are plain tokens; a receiver destroyed while still
+// in use shows up only as a non-zero "uses of destroyed receivers" count.
+//
+// The plugin source is included directly so its static helpers can be reached.
+// Build and run it under ThreadSanitizer as described in README.md.
+
+#include "../Source/NDIPTZControl.cpp"
+
+#include "HostCallbacks.h"
+#include "MockNDI.h"
+
+#include <stdio.h>
+#include <thread>
+
+static const int	kReaderThreads	= 3;
+static const int	kPTZWrites		= 1000000;
+static const int	kIndexChanges	= 2000;
+static const int	kCameras		= 4;
+
+static int gFailures = 0;
+
+static void
+Check(
+	bool			inCondition,
+	const char*		inWhat,
+	long			inActual,
+	long			inExpected)
+{
+	printf("  %-40s %8ld (expected %ld)  %s\n", inWhat, inActual, inExpected, inCondition ? "ok" : "FAILED");
+	if (!inCondition) {
+		gFailures++;
+	}
+}
+
+// ---------------------------------------------------------------------------------
+//		\245 TestPTZStateSeqlock
+// ---------------------------------------------------------------------------------
+
+static void
+TestPTZStateSeqlock()
+{
+	printf("PTZ seqlock: 1 writer, %d readers, %d writes\n", kReaderThreads, kPTZWrites);
+	
+	static PTZState state;
+	std::atomic<bool> done(false);
+	std::atomic<long> torn(0);
+	std::atomic<long> reads(0);
+	
+	std::vector<std::thread> readers;
+	for (int i = 0; i < kReaderThreads; i++) {
+		readers.push_back(std::thread([&]() {
+			while (!done.load()) {
+				PTZAmounts amounts = ReadPTZState(&state);
+				// every write stores (n, -n, n / 2) - anything else is a torn read
+				if (amounts.mVertAmount != -amounts.mHorizAmount || amounts.mZoomAmount != amounts.mHorizAmount * 0.5f) {
+					torn++;
+				}
+				reads++;
+			}
+		}));
+	}
+	
+	for (int n = 1; n <= kPTZWrites; n++) {
+		PTZAmounts amounts = { (float) n, (float) -n, n * 0.5f };
+		WritePTZState(&state, amounts);
+	}
+	
+	done = true;
+	for (size_t i = 0; i < readers.size(); i++) {
+		readers[i].join();
+	}
+	
+	PTZAmounts last = ReadPTZState(&state);
+	
+	Check(torn.load() == 0, "torn reads", torn.load(), 0);
+	Check(last.mHorizAmount == (float) kPTZWrites, "final horizontal amount", (long) last.mHorizAmount, kPTZWrites);
+	printf("  (%ld consistent reads)\n", reads.load());
+}
+
+// ---------------------------------------------------------------------------------
+//		\245 TestReceiverSwap
+// ---------------------------------------------------------------------------------
+
+static void
+SetProperty(
+	IsadoraParameters*	ip,
+	ActorInfo*			inActorInfo,
+	PropertyIndex		inPropertyIndex1,
+	Value				inValue)
+{
+	Value oldValue = inValue;
+	inActorInfo->mHandlePropertyChangeValueProc(ip, inActorInfo, inPropertyIndex1, &oldValue, &inValue, false);
+}
+
+static void
+TestReceiverSwap()
+{
+	printf("NDI receiver swap: %d ndi_index changes, %d triggering workers\n", kIndexChanges, kReaderThreads);
+	
+	MockNDI_Reset();
+	HostCallbacks_Reset();
+	MockNDI_SetCameraCount(kCameras);
+	MockNDI_SetCaptureDelayMicros(20);
+	
+	IsadoraParameters ip = IsadoraParameters();
+	ActorInfo actor = ActorInfo();
+	GetActorInfo(NULL, &actor);
+	actor.mCreateActorProc(&ip, &actor);
+	
+	std::atomic<bool> done(false);
+	
+	std::vector<std::thread> workers;
+	for (int i = 0; i < kReaderThreads; i++) {
+		workers.push_back(std::thread([&]() {
+			Value go = { kBoolean };
+			go.u.ivalue = 1;
+			while (!done.load()) {
+				SetProperty(&ip, &actor, kTriggerGo, go);
+			}
+		}));
+	}
+	
+	// this thread plays the Isadora callback thread
+	for (int n = 0; n < kIndexChanges; n++) {
+		Value index = { kInteger };
+		index.u.ivalue = n % kCameras;
+		SetProperty(&ip, &actor, kNDIIndex, index);
+		
+		Value amount = { kFloat };
+		amount.u.fvalue = (n % 200) / 100.0f - 1.0f;
+		SetProperty(&ip, &actor, kHorizAmnt, amount);
+	}
+	
+	done = true;
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+	
+	actor.mDisposeActorProc(&ip, &actor);
+	
+	MockNDICounters ndi = MockNDI_GetCounters();
+	HostCounters host = HostCallbacks_GetCounters();
+	
+	Check(ndi.mStaleReceiverUses == 0, "uses of destroyed receivers", ndi.mStaleReceiverUses, 0);
+	Check(ndi.mReceiversCreated == kIndexChanges, "receivers created", ndi.mReceiversCreated, kIndexChanges);
+	Check(ndi.mReceiversDestroyed == ndi.mReceiversCreated, "receivers destroyed", ndi.mReceiversDestroyed, ndi.mReceiversCreated);
+	Check(ndi.mFindersDestroyed == ndi.mFindersCreated, "finders destroyed", ndi.mFindersDestroyed, ndi.mFindersCreated);
+	Check(host.mLiveBytes == 0, "plugin bytes still allocated", host.mLiveBytes, 0);
+	Check(host.mAssertFailures == 0, "PluginAssert_ failures", host.mAssertFailures, 0);
+	printf("  (%ld PTZ moves sent)\n", ndi.mPanTiltCalls);
+}
+
+int
+main()
+{
+	TestPTZStateSeqlock();
+	TestReceiverSwap();
+	
+	printf("%s\n", gFailures == 0 ? "PASSED" : "FAILED");
+	return gFailures == 0 ? 0 : 1;
+}